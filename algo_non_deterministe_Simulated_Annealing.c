@@ -1,124 +1,259 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <time.h>
+#include <stdint.h>
+#include "checkpoint.h"
+#include "board_simd.h"
+#include "instance_gen.h"
 
-#define MAX_SIZE 100              // Taille maximale du taquin (réduite pour les tests)
+#define MAX_SIZE 100              // Taille maximale du taquin (réduite pour les tests, cases sur 16 bits)
 #define MAX_ITERATIONS_LARGE 500  // Nombre d'itérations pour les grandes tailles
 #define MAX_ITERATIONS_SMALL 1000 // Nombre d'itérations pour les petites tailles
 
+#define CHECKPOINT_FILE "simulated_annealing.ckpt"
+#define CHECKPOINT_KIND_ANNEALING 2
+#define CHECKPOINT_INTERVAL 5 // Secondes entre deux sauvegardes
+
 // Représente une position dans la matrice
 typedef struct
 {
     int x, y;
 } Position;
 
-// Calcul de l'énergie : Distance de Manhattan
-int calculateEnergy(int state[MAX_SIZE][MAX_SIZE], int final_state[MAX_SIZE][MAX_SIZE], int N)
+// État de la recherche conservé entre deux exécutions
+typedef struct
 {
-    int energy = 0;
-    for (int i = 0; i < N; i++)
-    {
-        for (int j = 0; j < N; j++)
-        {
-            int value = state[i][j];
-            if (value != 0)
-            {
-                for (int k = 0; k < N; k++)
-                {
-                    for (int l = 0; l < N; l++)
-                    {
-                        if (final_state[k][l] == value)
-                        {
-                            energy += abs(i - k) + abs(j - l);
-                        }
-                    }
-                }
-            }
-        }
-    }
-    return energy;
+    int resuming;                  // Reprise depuis un checkpoint en cours
+    int size_index;                // Indice de la taille courante dans sizes
+    int N;                         // Taille du taquin
+    int iteration;                 // Prochaine itération à exécuter
+    long results_size;             // Taille de execution_times.txt au moment de la sauvegarde
+    double T;                      // Température courante
+    double elapsed;                // Temps de résolution déjà écoulé (secondes)
+    uint64_t rng_state;            // État du générateur aléatoire
+    Position zero_pos;             // Position du vide
+    uint16_t state[MAX_SIZE * MAX_SIZE]; // État courant
+} AnnealingCheckpoint;
+
+// Format sur disque, suivi de N * N cases sur 16 bits.
+// N = 0 (sans cases) indique que les tailles avant size_index sont terminées.
+typedef struct
+{
+    int32_t size_index;
+    int32_t N;
+    int32_t iteration;
+    int32_t zero_x, zero_y;
+    int32_t reserved; // Alignement explicite de T, toujours 0
+    double T;
+    double elapsed;
+    uint64_t rng_state;
+    int64_t results_size;
+} AnnealingCheckpointRecord;
+
+// L'enregistrement est écrit tel quel : aucun octet de remplissage non initialisé
+_Static_assert(sizeof(AnnealingCheckpointRecord) == 6 * sizeof(int32_t) + 2 * sizeof(double) + 2 * sizeof(uint64_t),
+               "AnnealingCheckpointRecord contient du remplissage implicite");
+
+// Générateur xorshift64* : contrairement à rand(), son état peut être sauvegardé
+static uint64_t rng_state = 88172645463325252ULL;
+
+uint64_t nextRandom(void)
+{
+    return instance_next(&rng_state);
 }
 
-// Vérifie si une position est valide dans la matrice
-int isValidMove(int x, int y, int N)
+// Nombre aléatoire uniforme dans [0, 1]
+double randomUnit(void)
 {
-    return (x >= 0 && x < N && y >= 0 && y < N);
+    return (double)(nextRandom() >> 11) / (double)((1ULL << 53) - 1);
 }
 
-// Applique un mouvement (haut, bas, gauche, droite)
-void applyMove(int state[MAX_SIZE][MAX_SIZE], Position zero_pos, Position move, Position *new_zero_pos)
+// Sauvegarde l'état de la recherche de manière atomique
+void saveCheckpoint(AnnealingCheckpoint *ckpt, uint16_t state[MAX_SIZE * MAX_SIZE], Position zero_pos, int iteration, double T, double elapsed)
 {
-    int temp = state[move.x][move.y];
-    state[move.x][move.y] = state[zero_pos.x][zero_pos.y];
-    state[zero_pos.x][zero_pos.y] = temp;
-    new_zero_pos->x = move.x;
-    new_zero_pos->y = move.y;
+    static unsigned char buffer[sizeof(AnnealingCheckpointRecord) + MAX_SIZE * MAX_SIZE * sizeof(uint16_t)];
+    if (ckpt->N > MAX_SIZE)
+    {
+        fprintf(stderr, "Taille %d non supportée par les checkpoints (MAX_SIZE = %d).\n", ckpt->N, MAX_SIZE);
+        exit(EXIT_FAILURE);
+    }
+
+    AnnealingCheckpointRecord record = {
+        .size_index = ckpt->size_index,
+        .N = ckpt->N,
+        .iteration = iteration,
+        .zero_x = zero_pos.x,
+        .zero_y = zero_pos.y,
+        .T = T,
+        .elapsed = elapsed,
+        .rng_state = rng_state,
+        .results_size = ckpt->results_size};
+    memcpy(buffer, &record, sizeof(record));
+
+    memcpy(buffer + sizeof(record), state, (size_t)ckpt->N * ckpt->N * sizeof(uint16_t));
+
+    size_t size = sizeof(record) + (size_t)ckpt->N * ckpt->N * sizeof(uint16_t);
+    if (checkpoint_write(CHECKPOINT_FILE, CHECKPOINT_KIND_ANNEALING, buffer, size) != 0)
+    {
+        perror("Erreur d'écriture du checkpoint");
+    }
 }
 
-// Génère un état initial aléatoire
-void generateRandomState(int state[MAX_SIZE][MAX_SIZE], int N)
+// Enregistre que toutes les tailles avant size_index sont terminées
+void saveNextSize(int size_index, long results_size)
 {
-    int numbers[MAX_SIZE * MAX_SIZE];
-    for (int i = 0; i < N * N - 1; i++)
+    AnnealingCheckpointRecord record = {.size_index = size_index, .N = 0, .results_size = results_size};
+    if (checkpoint_write(CHECKPOINT_FILE, CHECKPOINT_KIND_ANNEALING, &record, sizeof(record)) != 0)
     {
-        numbers[i] = i + 1;
+        perror("Erreur d'écriture du checkpoint");
     }
-    numbers[N * N - 1] = 0; // Position du vide (0)
+}
 
-    // Mélange les nombres pour générer un état initial aléatoire
-    for (int i = 0; i < N * N; i++)
+// Charge un checkpoint existant, renvoie 1 si l'exécution doit reprendre.
+// ckpt->resuming vaut 1 seulement si une taille était en cours.
+int loadCheckpoint(AnnealingCheckpoint *ckpt)
+{
+    static unsigned char buffer[sizeof(AnnealingCheckpointRecord) + MAX_SIZE * MAX_SIZE * sizeof(uint16_t)];
+    long size = checkpoint_read(CHECKPOINT_FILE, CHECKPOINT_KIND_ANNEALING, buffer, sizeof(buffer));
+    if (size < (long)sizeof(AnnealingCheckpointRecord))
     {
-        int j = rand() % (N * N);
-        int temp = numbers[i];
-        numbers[i] = numbers[j];
-        numbers[j] = temp;
+        return 0;
     }
 
-    int idx = 0;
-    for (int i = 0; i < N; i++)
+    AnnealingCheckpointRecord record;
+    memcpy(&record, buffer, sizeof(record));
+    if (record.N == 0 && size == (long)sizeof(record))
     {
-        for (int j = 0; j < N; j++)
-        {
-            state[i][j] = numbers[idx++];
-        }
+        // Entre deux tailles : reprendre à la taille suivante, sans état
+        ckpt->resuming = 0;
+        ckpt->size_index = record.size_index;
+        ckpt->N = 0;
+        ckpt->results_size = (long)record.results_size;
+        return 1;
+    }
+    if (record.N < 0 || record.N > MAX_SIZE ||
+        size != (long)(sizeof(record) + (size_t)record.N * record.N * sizeof(uint16_t)))
+    {
+        return 0;
     }
+
+    ckpt->resuming = 1;
+    ckpt->size_index = record.size_index;
+    ckpt->N = record.N;
+    ckpt->iteration = record.iteration;
+    ckpt->results_size = (long)record.results_size;
+    ckpt->T = record.T;
+    ckpt->elapsed = record.elapsed;
+    ckpt->rng_state = record.rng_state;
+    ckpt->zero_pos.x = record.zero_x;
+    ckpt->zero_pos.y = record.zero_y;
+
+    memcpy(ckpt->state, buffer + sizeof(record), (size_t)record.N * record.N * sizeof(uint16_t));
+    return 1;
+}
+
+// Coordonnées de chaque case et position finale de chaque valeur (voir board_tables)
+static uint32_t cell_coords[MAX_SIZE * MAX_SIZE];
+static uint32_t goal_coords[MAX_SIZE * MAX_SIZE];
+
+// Prépare les tables de l'énergie pour l'état final d'une taille donnée
+void prepareEnergy(uint16_t final_state[MAX_SIZE * MAX_SIZE], int N)
+{
+    board_tables(final_state, N, cell_coords, goal_coords);
+}
+
+// Calcul de l'énergie : Distance de Manhattan
+int calculateEnergy(uint16_t state[MAX_SIZE * MAX_SIZE], int N)
+{
+    return board_manhattan(state, N * N, cell_coords, goal_coords);
+}
+
+// Vérifie si une position est valide dans la matrice
+int isValidMove(int x, int y, int N)
+{
+    return (x >= 0 && x < N && y >= 0 && y < N);
+}
+
+// Applique un mouvement (haut, bas, gauche, droite)
+void applyMove(uint16_t state[MAX_SIZE * MAX_SIZE], int N, Position zero_pos, Position move, Position *new_zero_pos)
+{
+    uint16_t temp = state[move.x * N + move.y];
+    state[move.x * N + move.y] = state[zero_pos.x * N + zero_pos.y];
+    state[zero_pos.x * N + zero_pos.y] = temp;
+    new_zero_pos->x = move.x;
+    new_zero_pos->y = move.y;
+}
+
+// Génère un état initial aléatoire, uniforme parmi les états solubles
+void generateRandomState(uint16_t state[MAX_SIZE * MAX_SIZE], int N)
+{
+    instance_uniform(state, N, &rng_state);
 }
 
 // Résolution du taquin avec Simulated Annealing
-void solveTaquin(int initial_state[MAX_SIZE][MAX_SIZE], int final_state[MAX_SIZE][MAX_SIZE], double T_initial, double alpha, int max_iterations, int N, FILE *file)
+void solveTaquin(uint16_t initial_state[MAX_SIZE * MAX_SIZE], uint16_t final_state[MAX_SIZE * MAX_SIZE], double T_initial, double alpha, int max_iterations, int N, FILE *file, AnnealingCheckpoint *ckpt)
 {
-    int current_state[MAX_SIZE][MAX_SIZE];
+    uint16_t current_state[MAX_SIZE * MAX_SIZE];
     Position zero_pos;
+    double T = T_initial;
+    int first_iteration = 0;
+    double elapsed_before = 0.0;
 
-    // Initialiser l'état courant et trouver la position initiale du 0
-    for (int i = 0; i < N; i++)
+    if (ckpt->resuming)
     {
-        for (int j = 0; j < N; j++)
+        // Reprise : l'état, la température et le générateur viennent du checkpoint
+        memcpy(current_state, ckpt->state, N * N * sizeof(uint16_t));
+        zero_pos = ckpt->zero_pos;
+        T = ckpt->T;
+        first_iteration = ckpt->iteration;
+        elapsed_before = ckpt->elapsed;
+        rng_state = ckpt->rng_state;
+        ckpt->resuming = 0;
+    }
+    else
+    {
+        // Initialiser l'état courant et trouver la position initiale du 0
+        for (int i = 0; i < N; i++)
         {
-            current_state[i][j] = initial_state[i][j];
-            if (current_state[i][j] == 0)
+            for (int j = 0; j < N; j++)
             {
-                zero_pos.x = i;
-                zero_pos.y = j;
+                current_state[i * N + j] = initial_state[i * N + j];
+                if (current_state[i * N + j] == 0)
+                {
+                    zero_pos.x = i;
+                    zero_pos.y = j;
+                }
             }
         }
     }
 
-    double T = T_initial;
     clock_t start_time, end_time;
 
+    // Sauvegarde au début de chaque taille, hors du temps mesuré
+    saveCheckpoint(ckpt, current_state, zero_pos, first_iteration, T, elapsed_before);
+    time_t last_checkpoint = time(NULL);
+
     // Démarrer le chronomètre pour mesurer le temps total de résolution
     start_time = clock();
 
     // Répéter le processus de Simulated Annealing
-    for (int iteration = 0; iteration < max_iterations; iteration++)
+    for (int iteration = first_iteration; iteration < max_iterations; iteration++)
     {
+        // Sauvegarde périodique de la recherche
+        if (time(NULL) - last_checkpoint >= CHECKPOINT_INTERVAL)
+        {
+            double elapsed = elapsed_before + ((double)(clock() - start_time)) / CLOCKS_PER_SEC;
+            saveCheckpoint(ckpt, current_state, zero_pos, iteration, T, elapsed);
+            last_checkpoint = time(NULL);
+        }
+
         // Vérifie si l'état courant est final
-        if (calculateEnergy(current_state, final_state, N) == 0)
+        if (board_equal(current_state, final_state, N * N))
         {
             end_time = clock(); // Fin du chronomètre
-            double time_taken = ((double)(end_time - start_time)) / CLOCKS_PER_SEC;
+            double time_taken = elapsed_before + ((double)(end_time - start_time)) / CLOCKS_PER_SEC;
             fprintf(file, "%d %.6f\n", N, time_taken); // Format souhaité : taille et temps
             return;
         }
@@ -130,42 +265,30 @@ void solveTaquin(int initial_state[MAX_SIZE][MAX_SIZE], int final_state[MAX_SIZE
             {zero_pos.x, zero_pos.y - 1}, // Gauche
             {zero_pos.x, zero_pos.y + 1}  // Droite
         };
-        int random_index = rand() % 4;
+        int random_index = nextRandom() % 4;
 
         // Vérifie si le mouvement est valide
         if (isValidMove(moves[random_index].x, moves[random_index].y, N))
         {
-            int new_state[MAX_SIZE][MAX_SIZE];
+            uint16_t new_state[MAX_SIZE * MAX_SIZE];
             Position new_zero_pos;
 
             // Copie l'état courant dans un nouvel état
-            for (int i = 0; i < N; i++)
-            {
-                for (int j = 0; j < N; j++)
-                {
-                    new_state[i][j] = current_state[i][j];
-                }
-            }
+            memcpy(new_state, current_state, N * N * sizeof(uint16_t));
 
             // Applique le mouvement
-            applyMove(new_state, zero_pos, moves[random_index], &new_zero_pos);
+            applyMove(new_state, N, zero_pos, moves[random_index], &new_zero_pos);
 
             // Calcul des énergies
-            int energy_current = calculateEnergy(current_state, final_state, N);
-            int energy_new = calculateEnergy(new_state, final_state, N);
+            int energy_current = calculateEnergy(current_state, N);
+            int energy_new = calculateEnergy(new_state, N);
 
             // Décision d'acceptation
             int delta_energy = energy_new - energy_current;
-            if (delta_energy < 0 || exp(-delta_energy / T) > ((double)rand() / RAND_MAX))
+            if (delta_energy < 0 || exp(-delta_energy / T) > randomUnit())
             {
                 // Accepte le nouvel état
-                for (int i = 0; i < N; i++)
-                {
-                    for (int j = 0; j < N; j++)
-                    {
-                        current_state[i][j] = new_state[i][j];
-                    }
-                }
+                memcpy(current_state, new_state, N * N * sizeof(uint16_t));
                 zero_pos = new_zero_pos;
             }
         }
@@ -175,13 +298,13 @@ void solveTaquin(int initial_state[MAX_SIZE][MAX_SIZE], int final_state[MAX_SIZE
     }
 
     end_time = clock(); // Fin du chronomètre si le taquin n'est pas résolu
-    double time_taken = ((double)(end_time - start_time)) / CLOCKS_PER_SEC;
+    double time_taken = elapsed_before + ((double)(end_time - start_time)) / CLOCKS_PER_SEC;
     fprintf(file, "%d %.6f\n", N, time_taken); // Format souhaité : taille et temps
 }
 
 int main()
 {
-    srand(time(NULL)); // Initialisation de la graine aléatoire
+    rng_state = instance_seed((uint64_t)time(NULL)); // Initialisation de la graine aléatoire
 
     // Paramètres de l'algorithme
     double T_initial = 1000.0;
@@ -190,8 +313,35 @@ int main()
     int max_iterations_large = MAX_ITERATIONS_LARGE;                             // Réduit les itérations pour les grandes tailles
     int sizes[] = {2, 3, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000}; // Tailles des taquins
 
-    // Ouvrir le fichier pour sauvegarder les résultats
-    FILE *file = fopen("execution_times.txt", "w");
+    int size_count = sizeof(sizes) / sizeof(sizes[0]);
+
+    // Reprendre une exécution interrompue si un checkpoint existe
+    static AnnealingCheckpoint ckpt;
+    int first_size = 0;
+    int resumed = loadCheckpoint(&ckpt) && ckpt.size_index >= 0 && ckpt.size_index <= size_count &&
+                  (ckpt.N == 0 || (ckpt.size_index < size_count && ckpt.N == sizes[ckpt.size_index]));
+    if (resumed)
+    {
+        first_size = ckpt.size_index;
+        if (ckpt.resuming)
+            printf("Reprise depuis le checkpoint : taille %d, itération %d.\n", ckpt.N, ckpt.iteration);
+        else
+            printf("Reprise depuis le checkpoint : %d taille(s) déjà traitée(s).\n", first_size);
+    }
+    else
+    {
+        ckpt.resuming = 0;
+    }
+
+    // Ouvrir le fichier pour sauvegarder les résultats. En cas de reprise, les
+    // lignes écrites après le checkpoint sont retirées pour ne pas être dupliquées.
+    if (resumed && truncate("execution_times.txt", ckpt.results_size) != 0)
+    {
+        resumed = 0;
+        ckpt.resuming = 0;
+        first_size = 0;
+    }
+    FILE *file = fopen("execution_times.txt", resumed ? "a" : "w");
     if (file == NULL)
     {
         printf("Erreur d'ouverture du fichier.\n");
@@ -199,11 +349,20 @@ int main()
     }
 
     // Boucle pour résoudre les taquins de différentes tailles
-    for (int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    for (int i = first_size; i < size_count; i++)
     {
         int N = sizes[i];
-        int initial_state[MAX_SIZE][MAX_SIZE];
-        int final_state[MAX_SIZE][MAX_SIZE];
+        if (N > MAX_SIZE)
+        {
+            // Les états sont des tableaux fixes de MAX_SIZE * MAX_SIZE cases sur 16 bits
+            printf("Taille %d ignorée : supérieure à MAX_SIZE (%d).\n", N, MAX_SIZE);
+            continue;
+        }
+        ckpt.size_index = i;
+        ckpt.N = N;
+        ckpt.results_size = ftell(file);
+        uint16_t initial_state[MAX_SIZE * MAX_SIZE];
+        uint16_t final_state[MAX_SIZE * MAX_SIZE];
 
         // Générer l'état final pour chaque taille
         int num = 1;
@@ -212,23 +371,31 @@ int main()
             for (int k = 0; k < N; k++)
             {
                 if (j == N - 1 && k == N - 1)
-                    final_state[j][k] = 0;
+                    final_state[j * N + k] = 0;
                 else
-                    final_state[j][k] = num++;
+                    final_state[j * N + k] = num++;
             }
         }
+        prepareEnergy(final_state, N);
 
-        // Générer un état initial aléatoire
-        generateRandomState(initial_state, N);
+        // Générer un état initial aléatoire (inutile en cas de reprise)
+        if (!ckpt.resuming)
+            generateRandomState(initial_state, N);
 
         // Modifier les itérations en fonction de la taille
         if (N <= 100)
-            solveTaquin(initial_state, final_state, T_initial, alpha, max_iterations, N, file);
+            solveTaquin(initial_state, final_state, T_initial, alpha, max_iterations, N, file, &ckpt);
         else
-            solveTaquin(initial_state, final_state, T_initial, alpha, max_iterations_large, N, file);
+            solveTaquin(initial_state, final_state, T_initial, alpha, max_iterations_large, N, file, &ckpt);
+
+        // La ligne est sur disque avant de marquer la taille comme terminée
+        fflush(file);
+        fsync(fileno(file));
+        saveNextSize(i + 1, ftell(file));
     }
 
-    fclose(file); // Fermer le fichier
+    fclose(file);           // Fermer le fichier
+    remove(CHECKPOINT_FILE); // Toutes les tailles sont traitées
 
     printf("Les temps d'exécution ont été sauvegardés dans 'execution_times.txt'.\n");
 
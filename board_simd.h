@@ -0,0 +1,232 @@
+#ifndef BOARD_SIMD_H
+#define BOARD_SIMD_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Whole-board kernels over contiguous row-major boards of 16-bit tiles.
+// The AVX2 or SSE4.1 version is picked at runtime, with a scalar fallback.
+//
+// Coordinates are packed as row | col << 16 so both components can be
+// handled in 16-bit lanes; boards must therefore be smaller than 32768 cells.
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BOARD_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define BOARD_SIMD_X86 0
+#endif
+
+// cell[p] = coordinates of position p, goal[t] = coordinates of tile t in goal_board
+static inline void board_tables(const uint16_t *goal_board, int n, uint32_t *cell, uint32_t *goal) {
+    for (int p = 0; p < n * n; p++) {
+        cell[p] = (uint32_t)(p / n) | (uint32_t)(p % n) << 16;
+        goal[goal_board[p]] = cell[p];
+    }
+}
+
+static inline int board_coord_distance(uint32_t a, uint32_t b) {
+    return abs((int)(a & 0xFFFF) - (int)(b & 0xFFFF)) + abs((int)(a >> 16) - (int)(b >> 16));
+}
+
+// Scalar kernels, also used for the tails of the vector loops
+
+static int board_manhattan_scalar(const uint16_t *board, int count, const uint32_t *cell, const uint32_t *goal) {
+    int dist = 0;
+    for (int p = 0; p < count; p++) {
+        if (board[p] != 0)
+            dist += board_coord_distance(goal[board[p]], cell[p]);
+    }
+    return dist;
+}
+
+static int board_equal_scalar(const uint16_t *a, const uint16_t *b, int count) {
+    for (int p = 0; p < count; p++) {
+        if (a[p] != b[p]) return 0;
+    }
+    return 1;
+}
+
+// Pairs (i, j), i < j, of non-blank tiles with board[i] > board[j]
+static long long board_inversions_scalar(const uint16_t *board, int count) {
+    long long inversions = 0;
+    for (int i = 0; i < count; i++) {
+        if (board[i] == 0) continue;
+        for (int j = i + 1; j < count; j++) {
+            if (board[j] != 0 && board[i] > board[j]) inversions++;
+        }
+    }
+    return inversions;
+}
+
+#if BOARD_SIMD_X86
+
+__attribute__((target("sse4.1")))
+static int board_hsum_sse4(__m128i v) {
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(v);
+}
+
+__attribute__((target("avx2")))
+static int board_hsum_avx2(__m256i v) {
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+}
+
+// SSE4.1 has no gather, so the goal lookups stay scalar and the distance
+// arithmetic runs four cells at a time.
+__attribute__((target("sse4.1")))
+static int board_manhattan_sse4(const uint16_t *board, int count, const uint32_t *cell, const uint32_t *goal) {
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i acc = _mm_setzero_si128();
+    int p = 0;
+    for (; p + 4 <= count; p += 4) {
+        __m128i tiles = _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *)(board + p)));
+        __m128i target = _mm_set_epi32((int)goal[board[p + 3]], (int)goal[board[p + 2]],
+                                       (int)goal[board[p + 1]], (int)goal[board[p]]);
+        __m128i here = _mm_loadu_si128((const __m128i *)(cell + p));
+        __m128i dist = _mm_abs_epi16(_mm_sub_epi16(target, here));
+        dist = _mm_andnot_si128(_mm_cmpeq_epi32(tiles, _mm_setzero_si128()), dist);
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(dist, ones));
+    }
+    return board_hsum_sse4(acc) + board_manhattan_scalar(board + p, count - p, cell + p, goal);
+}
+
+__attribute__((target("avx2")))
+static int board_manhattan_avx2(const uint16_t *board, int count, const uint32_t *cell, const uint32_t *goal) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i acc = _mm256_setzero_si256();
+    int p = 0;
+    for (; p + 8 <= count; p += 8) {
+        __m256i tiles = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(board + p)));
+        __m256i target = _mm256_i32gather_epi32((const int *)goal, tiles, 4);
+        __m256i here = _mm256_loadu_si256((const __m256i *)(cell + p));
+        __m256i dist = _mm256_abs_epi16(_mm256_sub_epi16(target, here));
+        dist = _mm256_andnot_si256(_mm256_cmpeq_epi32(tiles, _mm256_setzero_si256()), dist);
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(dist, ones));
+    }
+    return board_hsum_avx2(acc) + board_manhattan_scalar(board + p, count - p, cell + p, goal);
+}
+
+__attribute__((target("sse4.1")))
+static int board_equal_sse4(const uint16_t *a, const uint16_t *b, int count) {
+    int p = 0;
+    for (; p + 8 <= count; p += 8) {
+        __m128i eq = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i *)(a + p)),
+                                     _mm_loadu_si128((const __m128i *)(b + p)));
+        if (_mm_movemask_epi8(eq) != 0xFFFF) return 0;
+    }
+    return board_equal_scalar(a + p, b + p, count - p);
+}
+
+__attribute__((target("avx2")))
+static int board_equal_avx2(const uint16_t *a, const uint16_t *b, int count) {
+    int p = 0;
+    for (; p + 16 <= count; p += 16) {
+        __m256i eq = _mm256_cmpeq_epi16(_mm256_loadu_si256((const __m256i *)(a + p)),
+                                        _mm256_loadu_si256((const __m256i *)(b + p)));
+        if (_mm256_movemask_epi8(eq) != -1) return 0;
+    }
+    return board_equal_scalar(a + p, b + p, count - p);
+}
+
+// Per-lane counters are 16-bit and flushed to 32-bit after each tile, which
+// is safe as long as count < 32768 * lanes.
+__attribute__((target("sse4.1")))
+static long long board_inversions_sse4(const uint16_t *board, int count) {
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i zero = _mm_setzero_si128();
+    long long inversions = 0;
+    for (int i = 0; i < count; i++) {
+        if (board[i] == 0) continue;
+        __m128i tile = _mm_set1_epi16((short)board[i]);
+        __m128i lanes = _mm_setzero_si128();
+        int j = i + 1;
+        for (; j + 8 <= count; j += 8) {
+            __m128i other = _mm_loadu_si128((const __m128i *)(board + j));
+            __m128i smaller = _mm_and_si128(_mm_cmpgt_epi16(tile, other), _mm_cmpgt_epi16(other, zero));
+            lanes = _mm_sub_epi16(lanes, smaller);
+        }
+        inversions += board_hsum_sse4(_mm_madd_epi16(lanes, ones));
+        for (; j < count; j++) {
+            if (board[j] != 0 && board[i] > board[j]) inversions++;
+        }
+    }
+    return inversions;
+}
+
+__attribute__((target("avx2")))
+static long long board_inversions_avx2(const uint16_t *board, int count) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    const __m256i zero = _mm256_setzero_si256();
+    long long inversions = 0;
+    for (int i = 0; i < count; i++) {
+        if (board[i] == 0) continue;
+        __m256i tile = _mm256_set1_epi16((short)board[i]);
+        __m256i lanes = _mm256_setzero_si256();
+        int j = i + 1;
+        for (; j + 16 <= count; j += 16) {
+            __m256i other = _mm256_loadu_si256((const __m256i *)(board + j));
+            __m256i smaller = _mm256_and_si256(_mm256_cmpgt_epi16(tile, other), _mm256_cmpgt_epi16(other, zero));
+            lanes = _mm256_sub_epi16(lanes, smaller);
+        }
+        inversions += board_hsum_avx2(_mm256_madd_epi16(lanes, ones));
+        for (; j < count; j++) {
+            if (board[j] != 0 && board[i] > board[j]) inversions++;
+        }
+    }
+    return inversions;
+}
+
+#endif // BOARD_SIMD_X86
+
+typedef struct {
+    const char *name;
+    int (*manhattan)(const uint16_t *board, int count, const uint32_t *cell, const uint32_t *goal);
+    int (*equal)(const uint16_t *a, const uint16_t *b, int count);
+    long long (*inversions)(const uint16_t *board, int count);
+} BoardKernels;
+
+static BoardKernels board_kernels;
+
+static void board_simd_select(void) {
+#if BOARD_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        board_kernels = (BoardKernels){ "avx2", board_manhattan_avx2, board_equal_avx2, board_inversions_avx2 };
+        return;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        board_kernels = (BoardKernels){ "sse4.1", board_manhattan_sse4, board_equal_sse4, board_inversions_sse4 };
+        return;
+    }
+#endif
+    board_kernels = (BoardKernels){ "scalar", board_manhattan_scalar, board_equal_scalar, board_inversions_scalar };
+}
+
+// Name of the kernel set in use, for logging
+static inline const char *board_simd_name(void) {
+    if (!board_kernels.name) board_simd_select();
+    return board_kernels.name;
+}
+
+// Sum of the Manhattan distances of the non-blank tiles to their goal cells
+static inline int board_manhattan(const uint16_t *board, int count, const uint32_t *cell, const uint32_t *goal) {
+    if (!board_kernels.manhattan) board_simd_select();
+    return board_kernels.manhattan(board, count, cell, goal);
+}
+
+static inline int board_equal(const uint16_t *a, const uint16_t *b, int count) {
+    if (!board_kernels.equal) board_simd_select();
+    return board_kernels.equal(a, b, count);
+}
+
+static inline long long board_inversions(const uint16_t *board, int count) {
+    if (!board_kernels.inversions) board_simd_select();
+    return board_kernels.inversions(board, count);
+}
+
+#endif // BOARD_SIMD_H
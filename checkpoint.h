@@ -0,0 +1,112 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Compact binary checkpoint files shared by the long-running solvers.
+// A file is a fixed header followed by an opaque payload owned by the caller.
+
+#define CHECKPOINT_MAGIC 0x504B4354u // "TCKP"
+#define CHECKPOINT_PATH_MAX 512
+
+typedef struct {
+    uint32_t magic;
+    uint32_t kind;     // Which solver wrote the payload
+    uint32_t size;     // Payload size in bytes
+    uint32_t checksum; // FNV-1a of the payload, catches truncated files
+} CheckpointHeader;
+
+static uint32_t checkpoint_checksum(const void *data, size_t size) {
+    const unsigned char *bytes = data;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int checkpoint_write_all(int fd, const void *data, size_t size) {
+    const unsigned char *bytes = data;
+    while (size > 0) {
+        ssize_t written = write(fd, bytes, size);
+        if (written < 0) {
+            if (errno == EINTR) continue; // Interrupted by a signal, retry
+            return -1;
+        }
+        bytes += written;
+        size -= (size_t)written;
+    }
+    return 0;
+}
+
+// Write the payload to "<path>.tmp", fsync it and rename it over path, so a
+// crash leaves either the previous checkpoint or the new one, never a mix.
+static int checkpoint_write(const char *path, uint32_t kind, const void *payload, size_t size) {
+    char tmp_path[CHECKPOINT_PATH_MAX];
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) >= (int)sizeof(tmp_path)) return -1;
+
+    CheckpointHeader header = {
+        .magic = CHECKPOINT_MAGIC,
+        .kind = kind,
+        .size = (uint32_t)size,
+        .checksum = checkpoint_checksum(payload, size),
+    };
+
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return -1;
+    if (checkpoint_write_all(fd, &header, sizeof(header)) != 0 ||
+        checkpoint_write_all(fd, payload, size) != 0 ||
+        fsync(fd) != 0) {
+        close(fd);
+        unlink(tmp_path);
+        return -1;
+    }
+    if (close(fd) != 0 || rename(tmp_path, path) != 0) {
+        unlink(tmp_path);
+        return -1;
+    }
+
+    // Make the rename itself durable
+    char dir_path[CHECKPOINT_PATH_MAX];
+    const char *slash = strrchr(path, '/');
+    if (slash == NULL) {
+        strcpy(dir_path, ".");
+    } else {
+        size_t len = (size_t)(slash - path);
+        memcpy(dir_path, path, len == 0 ? 1 : len);
+        dir_path[len == 0 ? 1 : len] = '\0';
+    }
+    int dir_fd = open(dir_path, O_RDONLY);
+    if (dir_fd >= 0) {
+        fsync(dir_fd);
+        close(dir_fd);
+    }
+    return 0;
+}
+
+// Read a checkpoint of the given kind into payload (at most capacity bytes).
+// Returns the payload size, or -1 if the file is missing, foreign or corrupted.
+static long checkpoint_read(const char *path, uint32_t kind, void *payload, size_t capacity) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return -1;
+
+    CheckpointHeader header;
+    long result = -1;
+    if (fread(&header, sizeof(header), 1, file) == 1 &&
+        header.magic == CHECKPOINT_MAGIC && header.kind == kind &&
+        header.size <= capacity &&
+        fread(payload, 1, header.size, file) == header.size &&
+        checkpoint_checksum(payload, header.size) == header.checksum) {
+        result = (long)header.size;
+    }
+    fclose(file);
+    return result;
+}
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,242 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stdint.h>
+#include "instance_gen.h"
+
+#define MAX_N 255                  // Largest board whose tiles fit in 16 bits
+#define MAX_DUPLICATE_STREAK 1000000 // Give up when the instance space looks exhausted
+#define MAX_BAND_FAILURES 100        // Give up after this many walks in a row miss their target
+#define OUTPUT_BUFFER_SIZE (1 << 20)
+
+// Output file layout: "TINS", uint16 n, uint16 bytes per tile, then one
+// record of n * n tiles per instance (one byte per tile when n * n <= 256).
+// Every multi-byte integer is little-endian, whatever the host.
+
+typedef enum { MODE_UNIFORM, MODE_WALK, MODE_BAND, MODE_VERIFY } Mode;
+
+void usage(const char *program) {
+    fprintf(stderr, "Usage:\n");
+    fprintf(stderr, "  %s uniform <n> <count> <output> [seed]\n", program);
+    fprintf(stderr, "  %s walk <n> <count> <length> <output> [seed]\n", program);
+    fprintf(stderr, "  %s band <n> <count> <low> <high> <output> [seed]\n", program);
+    fprintf(stderr, "  %s verify <input>\n", program);
+}
+
+void write_header(FILE *output_file, int n, int tile_bytes) {
+    uint8_t header[8] = { 'T', 'I', 'N', 'S', (uint8_t)n, (uint8_t)(n >> 8), (uint8_t)tile_bytes, 0 };
+    fwrite(header, 1, sizeof(header), output_file);
+}
+
+// packed is a scratch buffer of count * tile_bytes bytes
+void write_board(FILE *output_file, const uint16_t *board, int count, int tile_bytes, uint8_t *packed) {
+    for (int p = 0; p < count; p++) {
+        packed[p * tile_bytes] = (uint8_t)board[p];
+        if (tile_bytes == 2) packed[p * 2 + 1] = (uint8_t)(board[p] >> 8);
+    }
+    fwrite(packed, tile_bytes, count, output_file);
+}
+
+// Check that every record of an instance file is a solvable board.
+// Returns the number of bad records, or -1 if the file cannot be read.
+long long verify_file(const char *input_path) {
+    FILE *input_file = fopen(input_path, "rb");
+    if (!input_file) {
+        perror("Failed to open file");
+        return -1;
+    }
+
+    uint8_t header[8];
+    if (fread(header, 1, sizeof(header), input_file) != sizeof(header) || memcmp(header, "TINS", 4) != 0) {
+        fprintf(stderr, "Not an instance file.\n");
+        fclose(input_file);
+        return -1;
+    }
+    int n = header[4] | header[5] << 8;
+    int tile_bytes = header[6] | header[7] << 8;
+    int cells = n * n;
+    if (n < 2 || n > MAX_N || tile_bytes != (cells <= 256 ? 1 : 2)) {
+        fprintf(stderr, "Unsupported instance file (n = %d, %d bytes per tile).\n", n, tile_bytes);
+        fclose(input_file);
+        return -1;
+    }
+
+    uint8_t *packed = malloc((size_t)cells * tile_bytes);
+    uint16_t *board = malloc(cells * sizeof(uint16_t));
+    uint8_t *visited = malloc(cells);
+    if (!packed || !board || !visited) {
+        fprintf(stderr, "Out of memory.\n");
+        fclose(input_file);
+        return -1;
+    }
+
+    long long checked = 0, invalid = 0, unsolvable = 0;
+    size_t got;
+    while ((got = fread(packed, tile_bytes, cells, input_file)) == (size_t)cells) {
+        checked++;
+        // instance_solvable follows the permutation, so check it is one first
+        memset(visited, 0, cells);
+        int valid = 1;
+        for (int p = 0; p < cells; p++) {
+            board[p] = tile_bytes == 2 ? (uint16_t)(packed[p * 2] | packed[p * 2 + 1] << 8) : packed[p];
+            if (board[p] >= cells || visited[board[p]]) {
+                valid = 0;
+                break;
+            }
+            visited[board[p]] = 1;
+        }
+        if (!valid)
+            invalid++;
+        else if (!instance_solvable(board, n, visited))
+            unsolvable++;
+    }
+    int truncated = got != 0;
+    int read_failed = ferror(input_file);
+    fclose(input_file);
+
+    printf("Board Size: %dx%d\n", n, n);
+    printf("Instances Checked: %lld\n", checked);
+    printf("Invalid Boards: %lld\n", invalid);
+    printf("Unsolvable Boards: %lld\n", unsolvable);
+    if (truncated)
+        fprintf(stderr, "The file ends with a partial record.\n");
+    if (read_failed)
+        perror("Failed to read file");
+
+    free(visited);
+    free(board);
+    free(packed);
+    return read_failed ? -1 : invalid + unsolvable + truncated;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    Mode mode;
+    int arg_count;
+    if (strcmp(argv[1], "uniform") == 0) {
+        mode = MODE_UNIFORM;
+        arg_count = 5;
+    } else if (strcmp(argv[1], "walk") == 0) {
+        mode = MODE_WALK;
+        arg_count = 6;
+    } else if (strcmp(argv[1], "band") == 0) {
+        mode = MODE_BAND;
+        arg_count = 7;
+    } else if (strcmp(argv[1], "verify") == 0) {
+        mode = MODE_VERIFY;
+        arg_count = 3;
+    } else {
+        usage(argv[0]);
+        return 1;
+    }
+    if (mode == MODE_VERIFY) {
+        if (argc != arg_count) {
+            usage(argv[0]);
+            return 1;
+        }
+        return verify_file(argv[2]) != 0;
+    }
+    if (argc != arg_count && argc != arg_count + 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    int n = atoi(argv[2]);
+    long long count = atoll(argv[3]);
+    int length = mode == MODE_WALK ? atoi(argv[4]) : 0;
+    int low = mode == MODE_BAND ? atoi(argv[4]) : 0;
+    int high = mode == MODE_BAND ? atoi(argv[5]) : 0;
+    const char *output_path = argv[arg_count - 1];
+    uint64_t seed = argc > arg_count ? strtoull(argv[arg_count], NULL, 10) : (uint64_t)time(NULL);
+
+    if (n < 2 || n > MAX_N || count <= 0 || length < 0 || low > high) {
+        fprintf(stderr, "Invalid arguments.\n");
+        usage(argv[0]);
+        return 1;
+    }
+    if (mode == MODE_BAND && low > instance_max_manhattan(n)) {
+        fprintf(stderr, "No %dx%d board has a Manhattan distance above %ld.\n", n, n, instance_max_manhattan(n));
+        return 1;
+    }
+
+    FILE *output_file = fopen(output_path, "wb");
+    if (!output_file) {
+        perror("Failed to open file");
+        return 1;
+    }
+    setvbuf(output_file, NULL, _IOFBF, OUTPUT_BUFFER_SIZE);
+
+    int cells = n * n;
+    int tile_bytes = cells <= 256 ? 1 : 2;
+    write_header(output_file, n, tile_bytes);
+
+    uint16_t *board = malloc(cells * sizeof(uint16_t));
+    uint8_t *packed = malloc((size_t)cells * tile_bytes);
+    InstanceSet seen;
+    if (!board || !packed || instance_set_init(&seen, (size_t)count) != 0) {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+
+    uint64_t rng = instance_seed(seed);
+    long max_steps = 1000L * cells; // Per attempt, for the band mode
+    long long written = 0, duplicates = 0, failures = 0, streak = 0, failure_streak = 0;
+    clock_t start_time = clock();
+
+    while (written < count && streak < MAX_DUPLICATE_STREAK && failure_streak < MAX_BAND_FAILURES) {
+        if (mode == MODE_UNIFORM) {
+            instance_uniform(board, n, &rng);
+        } else if (mode == MODE_WALK) {
+            instance_goal(board, n);
+            instance_walk(board, n, cells - 1, length, &rng);
+        } else if (instance_band(board, n, low, high, max_steps, &rng) < 0) {
+            failures++;
+            failure_streak++;
+            continue;
+        }
+        failure_streak = 0;
+
+        int added = instance_set_insert(&seen, instance_hash(board, cells));
+        if (added < 0) {
+            fprintf(stderr, "Out of memory.\n");
+            break;
+        }
+        if (!added) {
+            duplicates++;
+            streak++;
+            continue;
+        }
+        streak = 0;
+        write_board(output_file, board, cells, tile_bytes, packed);
+        if (ferror(output_file)) break; // Disk full or similar, no point going on
+        written++;
+    }
+
+    double time_taken = (double)(clock() - start_time) / CLOCKS_PER_SEC;
+    int write_failed = ferror(output_file);
+    if (fclose(output_file) != 0 || write_failed) {
+        perror("Failed to write file");
+        return 1;
+    }
+
+    printf("Seed: %llu\n", (unsigned long long)seed);
+    printf("Instances Written: %lld\n", written);
+    printf("Duplicates Dropped: %lld\n", duplicates);
+    if (mode == MODE_BAND)
+        printf("Walks Missing Their Target: %lld\n", failures);
+    printf("Time Taken: %.4f seconds (%.0f instances/s)\n", time_taken, time_taken > 0 ? written / time_taken : 0.0);
+    if (failure_streak >= MAX_BAND_FAILURES)
+        fprintf(stderr, "Stopped early: %d walks in a row missed their target distance.\n", MAX_BAND_FAILURES);
+    else if (written < count)
+        fprintf(stderr, "Stopped early: only %lld distinct instances found.\n", written);
+
+    instance_set_free(&seen);
+    free(packed);
+    free(board);
+    return written < count;
+}
@@ -3,63 +3,111 @@
 #include <string.h>
 #include <math.h>
 #include <time.h>
+#include <stdint.h>
+#include "checkpoint.h"
+#include "board_simd.h"
+#include "instance_gen.h"
 
 #define INF 1e9
 #define MAX_N 10 // Maximum size of the grid
+#define MAX_DEPTH 1000 // Maximum length of a solution path
+
+#define CHECKPOINT_FILE "ida_star.ckpt"
+#define CHECKPOINT_KIND_IDA 1
+#define CHECKPOINT_INTERVAL 5        // Seconds between two checkpoints
+#define CHECKPOINT_CHECK_MASK 0xFFFF // Look at the clock every 65536 nodes
+
+// What a checkpoint describes
+#define CHECKPOINT_IN_ITERATION 0    // Inside an iteration, the DFS path follows the record
+#define CHECKPOINT_NEXT_ITERATION 1  // Between iterations, threshold is the next one to run
+#define CHECKPOINT_SOLVED 2          // The size is finished, the job goes on with the next one
 
 typedef struct {
-    int grid[MAX_N][MAX_N];
+    uint16_t grid[MAX_N * MAX_N]; // Row-major tiles, cell (i, j) at i * n + j
     int x, y; // Position of the empty tile
     int n;    // Size of the grid
 } State;
 
 typedef struct {
-    State states[1000]; // To store states of the solution path
-    int size;           // Number of states in the solution path
+    State states[MAX_DEPTH]; // To store states of the solution path
+    int size;                // Number of states in the solution path
 } SolutionPath;
 
+// Search progress that survives a restart. The DFS frontier is the current
+// path: at each depth, the child being explored (earlier siblings are done)
+// and the smallest pruned f found among those finished siblings.
+typedef struct {
+    State start;              // Root of the search
+    int threshold;            // Threshold of the current iteration
+    int iterations;           // Iterations started so far
+    long long int total_nodes; // Nodes expanded by finished iterations
+    int moves[MAX_DEPTH];     // Child index being explored at each depth
+    int mins[MAX_DEPTH];      // Best pruned f of the finished siblings at each depth
+    int resuming;             // Replaying the saved path after a restart
+    int resume_depth;         // Depth of the node the checkpoint was taken at
+    long long int resume_nodes; // Nodes expanded in the iteration at that point
+    double elapsed;           // Time spent in the current iteration before the restart
+    clock_t iteration_start;  // Clock when the current iteration (re)started
+    long results_size;        // Length of results.txt when the current iteration started
+    int solved;               // The size was finished before the restart
+    time_t last_write;        // Time of the last checkpoint
+} Checkpoint;
+
+// On-disk layout, followed by depth move bytes and depth int32 minimums
+typedef struct {
+    uint8_t n, x, y, pad;
+    uint8_t grid[MAX_N * MAX_N];
+    int32_t threshold;
+    int32_t iterations;
+    int32_t depth;
+    int32_t phase; // CHECKPOINT_IN_ITERATION, CHECKPOINT_NEXT_ITERATION or CHECKPOINT_SOLVED
+    int64_t total_nodes;
+    int64_t nodes_expanded;
+    int64_t results_size; // Length of results.txt, later rows are dropped on resume
+    double elapsed;       // Time spent in the current iteration
+} CheckpointRecord;
+
+// The record is checksummed and written as is, so it must not contain
+// uninitialized padding bytes
+_Static_assert(sizeof(CheckpointRecord) == 4 + MAX_N * MAX_N + 4 * sizeof(int32_t) + 3 * sizeof(int64_t) + sizeof(double),
+               "CheckpointRecord has implicit padding");
+
 int dx[] = {-1, 1, 0, 0}; // Row movement directions
 int dy[] = {0, 0, -1, 1}; // Column movement directions
 
-void generate_goal(int n, int goal[MAX_N][MAX_N]) {
+uint32_t cell_coords[MAX_N * MAX_N]; // Coordinates of each cell, see board_tables
+uint32_t goal_coords[MAX_N * MAX_N]; // Goal coordinates of each tile
+uint64_t rng_state;                  // Random generator used for shuffling
+
+void generate_goal(int n, uint16_t goal[MAX_N * MAX_N]) {
     int value = 1;
     for (int i = 0; i < n; i++) {
         for (int j = 0; j < n; j++) {
             if (i == n - 1 && j == n - 1)
-                goal[i][j] = 0; // Empty tile
+                goal[i * n + j] = 0; // Empty tile
             else
-                goal[i][j] = value++;
+                goal[i * n + j] = value++;
         }
     }
+    board_tables(goal, n, cell_coords, goal_coords);
 }
 
 int manhattan_distance(State *state) {
-    int dist = 0;
-    for (int i = 0; i < state->n; i++) {
-        for (int j = 0; j < state->n; j++) {
-            if (state->grid[i][j] != 0) {
-                int value = state->grid[i][j] - 1;
-                int goal_x = value / state->n, goal_y = value % state->n;
-                dist += abs(i - goal_x) + abs(j - goal_y);
-            }
-        }
-    }
-    return dist;
+    return board_manhattan(state->grid, state->n * state->n, cell_coords, goal_coords);
 }
 
-int is_goal(State *state, int goal[MAX_N][MAX_N]) {
-    for (int i = 0; i < state->n; i++) {
-        for (int j = 0; j < state->n; j++) {
-            if (state->grid[i][j] != goal[i][j]) {
-                return 0;
-            }
-        }
-    }
-    return 1;
+// Distance of the tile at cell (x, y) to its goal cell
+int tile_distance(State *state, int x, int y) {
+    int cell = x * state->n + y;
+    return board_coord_distance(goal_coords[state->grid[cell]], cell_coords[cell]);
+}
+
+int is_goal(State *state, uint16_t goal[MAX_N * MAX_N]) {
+    return board_equal(state->grid, goal, state->n * state->n);
 }
 
 void copy_state(State *dest, State *src) {
-    memcpy(dest->grid, src->grid, sizeof(src->grid));
+    memcpy(dest->grid, src->grid, src->n * src->n * sizeof(src->grid[0]));
     dest->x = src->x;
     dest->y = src->y;
     dest->n = src->n;
@@ -69,9 +117,108 @@ int is_valid(int x, int y, int n) {
     return x >= 0 && x < n && y >= 0 && y < n;
 }
 
-int ida_search(State *state, int g, int threshold, long long int *nodes_expanded, SolutionPath *solution, int goal[MAX_N][MAX_N]) {
+void init_checkpoint(Checkpoint *ckpt, State *start) {
+    memset(ckpt, 0, sizeof(*ckpt));
+    copy_state(&ckpt->start, start);
+    ckpt->threshold = manhattan_distance(start);
+    ckpt->last_write = time(NULL);
+}
+
+// Only CHECKPOINT_IN_ITERATION records carry a DFS path (depth > 0)
+void save_checkpoint(Checkpoint *ckpt, int phase, int depth, long long int nodes_expanded) {
+    unsigned char buffer[sizeof(CheckpointRecord) + MAX_DEPTH * (1 + sizeof(int32_t))];
+    CheckpointRecord record = {
+        .n = ckpt->start.n, .x = ckpt->start.x, .y = ckpt->start.y,
+        .threshold = ckpt->threshold,
+        .iterations = ckpt->iterations,
+        .depth = depth,
+        .phase = phase,
+        .total_nodes = ckpt->total_nodes,
+        .nodes_expanded = nodes_expanded,
+        .results_size = ckpt->results_size,
+    };
+    if (phase == CHECKPOINT_IN_ITERATION)
+        record.elapsed = ckpt->elapsed + (double)(clock() - ckpt->iteration_start) / CLOCKS_PER_SEC;
+    for (int i = 0; i < ckpt->start.n; i++)
+        for (int j = 0; j < ckpt->start.n; j++)
+            record.grid[i * ckpt->start.n + j] = ckpt->start.grid[i * ckpt->start.n + j];
+
+    unsigned char *p = buffer;
+    memcpy(p, &record, sizeof(record));
+    p += sizeof(record);
+    for (int d = 0; d < depth; d++)
+        *p++ = (unsigned char)ckpt->moves[d];
+    for (int d = 0; d < depth; d++) {
+        int32_t min = ckpt->mins[d];
+        memcpy(p, &min, sizeof(min));
+        p += sizeof(min);
+    }
+
+    if (checkpoint_write(CHECKPOINT_FILE, CHECKPOINT_KIND_IDA, buffer, (size_t)(p - buffer)) != 0)
+        perror("Failed to write checkpoint");
+}
+
+// Returns 1 if a checkpoint was found and loaded, whatever its size
+int load_checkpoint(Checkpoint *ckpt) {
+    unsigned char buffer[sizeof(CheckpointRecord) + MAX_DEPTH * (1 + sizeof(int32_t))];
+    long size = checkpoint_read(CHECKPOINT_FILE, CHECKPOINT_KIND_IDA, buffer, sizeof(buffer));
+    if (size < (long)sizeof(CheckpointRecord)) return 0;
+
+    CheckpointRecord record;
+    memcpy(&record, buffer, sizeof(record));
+    int n = record.n;
+    if (n < 2 || n > MAX_N || record.depth < 0 || record.depth >= MAX_DEPTH ||
+        record.phase < CHECKPOINT_IN_ITERATION || record.phase > CHECKPOINT_SOLVED ||
+        (record.phase != CHECKPOINT_IN_ITERATION && record.depth != 0) || record.results_size < 0 ||
+        size != (long)(sizeof(record) + record.depth * (1 + sizeof(int32_t))))
+        return 0;
+
+    memset(ckpt, 0, sizeof(*ckpt));
+    ckpt->start.n = record.n;
+    ckpt->start.x = record.x;
+    ckpt->start.y = record.y;
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++)
+            ckpt->start.grid[i * n + j] = record.grid[i * n + j];
+    ckpt->threshold = record.threshold;
+    ckpt->iterations = record.iterations;
+    ckpt->total_nodes = record.total_nodes;
+    ckpt->results_size = (long)record.results_size;
+    ckpt->solved = record.phase == CHECKPOINT_SOLVED;
+    ckpt->last_write = time(NULL);
+    if (record.phase != CHECKPOINT_IN_ITERATION) return 1; // Nothing to replay
+
+    const unsigned char *p = buffer + sizeof(record);
+    for (int d = 0; d < record.depth; d++) {
+        ckpt->moves[d] = *p++;
+        if (ckpt->moves[d] > 3) return 0;
+    }
+    for (int d = 0; d < record.depth; d++) {
+        int32_t min;
+        memcpy(&min, p, sizeof(min));
+        p += sizeof(min);
+        ckpt->mins[d] = min;
+    }
+
+    ckpt->resuming = 1;
+    ckpt->resume_depth = record.depth;
+    // Replaying the path counts its nodes again, including the checkpointed one
+    ckpt->resume_nodes = record.nodes_expanded - record.depth - 1;
+    ckpt->elapsed = record.elapsed;
+    return 1;
+}
+
+// h is the Manhattan distance of state, updated incrementally from the parent
+int ida_search(State *state, int g, int h, int threshold, long long int *nodes_expanded, SolutionPath *solution, uint16_t goal[MAX_N * MAX_N], Checkpoint *ckpt) {
     (*nodes_expanded)++;
-    int f = g + manhattan_distance(state);
+    if (ckpt->resuming && g == ckpt->resume_depth) {
+        ckpt->resuming = 0; // Back at the node the checkpoint was taken at
+    } else if ((*nodes_expanded & CHECKPOINT_CHECK_MASK) == 0 && time(NULL) - ckpt->last_write >= CHECKPOINT_INTERVAL) {
+        save_checkpoint(ckpt, CHECKPOINT_IN_ITERATION, g, *nodes_expanded);
+        ckpt->last_write = time(NULL);
+    }
+
+    int f = g + h;
     if (f > threshold) return f;
     if (is_goal(state, goal)) {
         solution->states[solution->size++] = *state; // Add goal state to solution path
@@ -79,19 +226,29 @@ int ida_search(State *state, int g, int threshold, long long int *nodes_expanded
     }
 
     int min_threshold = INF;
-    for (int i = 0; i < 4; i++) {
+    int first_move = 0;
+    if (ckpt->resuming) {
+        // Skip the children that were already explored before the restart
+        first_move = ckpt->moves[g];
+        min_threshold = ckpt->mins[g];
+    }
+    for (int i = first_move; i < 4; i++) {
         int nx = state->x + dx[i];
         int ny = state->y + dy[i];
         if (is_valid(nx, ny, state->n)) {
             State neighbor;
             copy_state(&neighbor, state);
             // Swap tiles
-            neighbor.grid[state->x][state->y] = neighbor.grid[nx][ny];
-            neighbor.grid[nx][ny] = 0;
+            int neighbor_h = h - tile_distance(state, nx, ny);
+            neighbor.grid[state->x * state->n + state->y] = neighbor.grid[nx * state->n + ny];
+            neighbor.grid[nx * state->n + ny] = 0;
             neighbor.x = nx;
             neighbor.y = ny;
+            neighbor_h += tile_distance(&neighbor, state->x, state->y);
 
-            int result = ida_search(&neighbor, g + 1, threshold, nodes_expanded, solution, goal);
+            ckpt->moves[g] = i;
+            ckpt->mins[g] = min_threshold;
+            int result = ida_search(&neighbor, g + 1, neighbor_h, threshold, nodes_expanded, solution, goal, ckpt);
             if (result == -1) {
                 solution->states[solution->size++] = *state; // Add current state to solution path
                 return -1; // Solution found
@@ -108,7 +265,7 @@ void visualize_solution(SolutionPath *solution, FILE *output_file) {
         fprintf(output_file, "Step %d:\n", solution->size - i);
         for (int row = 0; row < solution->states[i].n; row++) {
             for (int col = 0; col < solution->states[i].n; col++) {
-                fprintf(output_file, "%2d ", solution->states[i].grid[row][col]);
+                fprintf(output_file, "%2d ", solution->states[i].grid[row * solution->states[i].n + col]);
             }
             fprintf(output_file, "\n");
         }
@@ -116,51 +273,57 @@ void visualize_solution(SolutionPath *solution, FILE *output_file) {
     }
 }
 
+// Non-backtracking random walk, so every move actually moves away
 void shuffle_state(State *state) {
     int n = state->n;
     int total_moves = n * n * 10; // Arbitrary number of moves to shuffle
-    for (int i = 0; i < total_moves; i++) {
-        int random_direction = rand() % 4;
-        int nx = state->x + dx[random_direction];
-        int ny = state->y + dy[random_direction];
-        if (is_valid(nx, ny, n)) {
-            // Swap tiles
-            state->grid[state->x][state->y] = state->grid[nx][ny];
-            state->grid[nx][ny] = 0;
-            state->x = nx;
-            state->y = ny;
-        }
-    }
+    int blank = instance_walk(state->grid, n, state->x * n + state->y, total_moves, &rng_state);
+    state->x = blank / n;
+    state->y = blank % n;
 }
 
-void ida_star(State *start, int goal[MAX_N][MAX_N], FILE *output_file) {
-    int threshold = manhattan_distance(start);
-    int iterations = 0;
-    long long int total_nodes_expanded = 0;
+// Put the rows written so far on disk before a checkpoint points past them
+void sync_results(FILE *output_file, Checkpoint *ckpt) {
+    fflush(output_file);
+    fsync(fileno(output_file));
+    ckpt->results_size = ftell(output_file);
+}
 
+void ida_star(Checkpoint *ckpt, uint16_t goal[MAX_N * MAX_N], FILE *output_file) {
     SolutionPath solution = { .size = 0 };
 
     while (1) {
-        iterations++;
         long long int nodes_expanded = 0;
-        clock_t start_time = clock();
+        sync_results(output_file, ckpt);
+        if (ckpt->resuming) {
+            nodes_expanded = ckpt->resume_nodes; // Continue the interrupted iteration
+        } else {
+            // A restart before the first periodic checkpoint reruns this iteration only
+            save_checkpoint(ckpt, CHECKPOINT_NEXT_ITERATION, 0, 0);
+            ckpt->last_write = time(NULL);
+            ckpt->iterations++;
+            ckpt->elapsed = 0;
+        }
+        int threshold = ckpt->threshold;
+        int iterations = ckpt->iterations;
+        ckpt->iteration_start = clock();
 
-        int result = ida_search(start, 0, threshold, &nodes_expanded, &solution, goal);
+        int result = ida_search(&ckpt->start, 0, manhattan_distance(&ckpt->start), threshold, &nodes_expanded, &solution, goal, ckpt);
 
-        clock_t end_time = clock();
-        double time_taken = (double)(end_time - start_time) / CLOCKS_PER_SEC;
+        // Includes the time spent in this iteration before a restart
+        double time_taken = ckpt->elapsed + (double)(clock() - ckpt->iteration_start) / CLOCKS_PER_SEC;
 
         fprintf(output_file, "Iteration %d:\n", iterations);
         fprintf(output_file, "  Threshold: %d\n", threshold);
         fprintf(output_file, "  Nodes Expanded: %lld\n", nodes_expanded);
         fprintf(output_file, "  Time Taken: %.4f seconds\n\n", time_taken);
 
-        total_nodes_expanded += nodes_expanded;
+        ckpt->total_nodes += nodes_expanded;
 
         if (result == -1) {
             fprintf(output_file, "Solution Found!\n");
             fprintf(output_file, "Total Iterations: %d\n", iterations);
-            fprintf(output_file, "Total Nodes Expanded: %lld\n", total_nodes_expanded);
+            fprintf(output_file, "Total Nodes Expanded: %lld\n", ckpt->total_nodes);
             fprintf(output_file, "Solution Depth: %d\n", threshold);
             visualize_solution(&solution, output_file);
             break;
@@ -169,12 +332,23 @@ void ida_star(State *start, int goal[MAX_N][MAX_N], FILE *output_file) {
             fprintf(output_file, "No Solution!\n");
             break;
         }
-        threshold = result;
+        ckpt->threshold = result;
     }
+
+    // Mark the size as finished so a restart goes on with the next one
+    sync_results(output_file, ckpt);
+    save_checkpoint(ckpt, CHECKPOINT_SOLVED, 0, 0);
 }
 
 int main() {
-    srand(time(NULL));
+    rng_state = instance_seed((uint64_t)time(NULL));
+
+    // A checkpoint covers the whole job: sizes below the one it holds are
+    // finished. Rows written after it are dropped so they are not duplicated.
+    static Checkpoint ckpt;
+    int resume_n = load_checkpoint(&ckpt) ? ckpt.start.n : 0;
+    if (resume_n && truncate("results.txt", ckpt.results_size) != 0)
+        resume_n = 0;
 
     FILE *output_file = fopen("results.txt", "a");
     if (!output_file) {
@@ -184,22 +358,31 @@ int main() {
 
     time_t current_time = time(NULL);
     fprintf(output_file, "Execution Date and Time: %s\n", ctime(&current_time));
+    fprintf(output_file, "Board kernels: %s\n", board_simd_name());
 
     for (int n = 6; n <= 6; n++) { // Adjust range as needed
+        if (n < resume_n || (n == resume_n && ckpt.solved))
+            continue; // Finished before the restart
         fprintf(output_file, "Solving %dx%d Puzzle:\n", n, n);
 
-        int goal[MAX_N][MAX_N];
+        uint16_t goal[MAX_N * MAX_N];
         generate_goal(n, goal);
 
-        State start = { .n = n };
-        memcpy(start.grid, goal, sizeof(goal));
-        start.x = n - 1;
-        start.y = n - 1;
+        if (n == resume_n) {
+            fprintf(output_file, "Resuming from checkpoint: iteration %d, threshold %d\n", ckpt.iterations + !ckpt.resuming, ckpt.threshold);
+        } else {
+            State start = { .n = n };
+            memcpy(start.grid, goal, sizeof(goal));
+            start.x = n - 1;
+            start.y = n - 1;
 
-        shuffle_state(&start);
-        ida_star(&start, goal, output_file);
+            shuffle_state(&start);
+            init_checkpoint(&ckpt, &start);
+        }
+        ida_star(&ckpt, goal, output_file);
     }
 
     fclose(output_file);
+    remove(CHECKPOINT_FILE); // Every size is done, nothing to resume
     return 0;
 }
@@ -0,0 +1,248 @@
+#ifndef INSTANCE_GEN_H
+#define INSTANCE_GEN_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Sliding puzzle instance generator shared by the solvers.
+// Boards are contiguous row-major arrays of n * n 16-bit tiles and the goal
+// is 1, 2, ..., n * n - 1 with the blank (0) in the bottom-right corner.
+// Every generator takes an explicit RNG state so callers can save it.
+
+// Seed an RNG state with splitmix64 (xorshift needs a non-zero state)
+static inline uint64_t instance_seed(uint64_t seed) {
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return z != 0 ? z : 0x9E3779B97F4A7C15ULL;
+}
+
+// xorshift64*
+static inline uint64_t instance_next(uint64_t *rng) {
+    *rng ^= *rng >> 12;
+    *rng ^= *rng << 25;
+    *rng ^= *rng >> 27;
+    return *rng * 2685821657736338717ULL;
+}
+
+// Uniform integer in [0, bound), without modulo bias (Lemire's method)
+static inline uint32_t instance_below(uint64_t *rng, uint32_t bound) {
+    uint64_t m = (uint64_t)(uint32_t)(instance_next(rng) >> 32) * bound;
+    if ((uint32_t)m < bound) {
+        uint32_t threshold = (uint32_t)-bound % bound;
+        while ((uint32_t)m < threshold)
+            m = (uint64_t)(uint32_t)(instance_next(rng) >> 32) * bound;
+    }
+    return (uint32_t)(m >> 32);
+}
+
+static inline void instance_goal(uint16_t *board, int n) {
+    for (int p = 0; p < n * n - 1; p++)
+        board[p] = (uint16_t)(p + 1);
+    board[n * n - 1] = 0;
+}
+
+// Unbiased Fisher-Yates shuffle of the whole board, blank included.
+// Half of the results are unsolvable. Returns the parity of the applied
+// permutation (the number of swaps that exchanged two cells, mod 2).
+static inline int instance_shuffle(uint16_t *board, int n, uint64_t *rng) {
+    int parity = 0;
+    for (int p = n * n - 1; p > 0; p--) {
+        int q = (int)instance_below(rng, (uint32_t)p + 1);
+        uint16_t tmp = board[p];
+        board[p] = board[q];
+        board[q] = tmp;
+        parity ^= q != p;
+    }
+    return parity;
+}
+
+// Parity of the blank's taxicab distance to its goal cell
+static inline int instance_blank_parity(int blank, int n) {
+    return ((n - 1 - blank / n) + (n - 1 - blank % n)) & 1;
+}
+
+// A board is solvable iff the parity of its permutation (blank counted as
+// the last tile) equals the parity of the blank's distance to its goal cell.
+// Uses cycle counting, so it is linear in the number of cells; visited is a
+// caller-provided scratch buffer of n * n bytes.
+static inline int instance_solvable(const uint16_t *board, int n, uint8_t *visited) {
+    int count = n * n;
+    memset(visited, 0, (size_t)count);
+
+    int cycles = 0, blank = 0;
+    for (int p = 0; p < count; p++) {
+        if (board[p] == 0) blank = p;
+        if (visited[p]) continue;
+        cycles++;
+        for (int q = p; !visited[q]; q = board[q] == 0 ? count - 1 : board[q] - 1)
+            visited[q] = 1;
+    }
+    return ((count - cycles) & 1) == instance_blank_parity(blank, n);
+}
+
+// Uniformly random solvable board: shuffle, then swap two tiles if needed.
+// Swapping two non-blank tiles flips the parity and pairs every unsolvable
+// board with exactly one solvable one, so the result stays uniform.
+// The shuffle reports its own parity, so no solvability scan is needed.
+static inline void instance_uniform(uint16_t *board, int n, uint64_t *rng) {
+    instance_goal(board, n);
+    if (n < 2) return;
+    int parity = instance_shuffle(board, n, rng);
+    int blank = 0;
+    while (board[blank] != 0)
+        blank++;
+    if (parity != instance_blank_parity(blank, n)) {
+        int a = board[0] != 0 ? 0 : 2;
+        int b = board[1] != 0 ? 1 : 2;
+        uint16_t tmp = board[a];
+        board[a] = board[b];
+        board[b] = tmp;
+    }
+}
+
+static inline int instance_tile_distance(int tile, int p, int n) {
+    return abs((tile - 1) / n - p / n) + abs((tile - 1) % n - p % n);
+}
+
+// One step of a non-backtracking walk: slide the blank in a random
+// direction other than back where it came from. *last is the previous
+// direction (-1 at the start) and *h, if given, the Manhattan distance.
+static inline void instance_step(uint16_t *board, int n, int *blank, int *last, int *h, uint64_t *rng) {
+    static const int dx[] = {-1, 1, 0, 0};
+    static const int dy[] = {0, 0, -1, 1};
+    int x = *blank / n, y = *blank % n;
+    int options[4], count = 0;
+    for (int d = 0; d < 4; d++) {
+        int nx = x + dx[d], ny = y + dy[d];
+        if (nx >= 0 && nx < n && ny >= 0 && ny < n && (*last < 0 || d != (*last ^ 1)))
+            options[count++] = d;
+    }
+
+    int d = options[instance_below(rng, (uint32_t)count)];
+    int next = (x + dx[d]) * n + (y + dy[d]);
+    int tile = board[next];
+    if (h)
+        *h += instance_tile_distance(tile, *blank, n) - instance_tile_distance(tile, next, n);
+    board[*blank] = (uint16_t)tile;
+    board[next] = 0;
+    *blank = next;
+    *last = d;
+}
+
+// Exactly length non-backtracking blank moves from the current board.
+// Returns the new blank index.
+static inline int instance_walk(uint16_t *board, int n, int blank, int length, uint64_t *rng) {
+    if (n < 2) return blank;
+    int last = -1;
+    for (int i = 0; i < length; i++)
+        instance_step(board, n, &blank, &last, NULL, rng);
+    return blank;
+}
+
+// Upper bound on the Manhattan distance of any n x n board: every cell
+// sent to the opposite corner, which maximizes rows and columns at once.
+static inline long instance_max_manhattan(int n) {
+    long line = 0;
+    for (int r = 0; r < n; r++)
+        line += labs(2L * r - (n - 1));
+    return 2L * n * line;
+}
+
+// Walk from the goal until the Manhattan distance equals a target drawn
+// uniformly in [low, high]. Every move changes the distance by exactly one,
+// so stopping at the first board inside the band would only ever yield low.
+// Gives up after max_steps moves and returns -1, else the walk length.
+static inline long instance_band(uint16_t *board, int n, int low, int high, long max_steps, uint64_t *rng) {
+    instance_goal(board, n);
+    if (low < 0) low = 0;
+    if (high > instance_max_manhattan(n)) high = (int)instance_max_manhattan(n);
+    if (low > high) return -1;
+    int target = low + (int)instance_below(rng, (uint32_t)(high - low) + 1);
+
+    int blank = n * n - 1, last = -1, h = 0;
+    if (h == target) return 0;
+    if (n < 2) return -1;
+    for (long step = 1; step <= max_steps; step++) {
+        instance_step(board, n, &blank, &last, &h, rng);
+        if (h == target) return step;
+    }
+    return -1;
+}
+
+// 64-bit hash of a board, four tiles packed per word
+static inline uint64_t instance_hash(const uint16_t *board, int count) {
+    uint64_t h = 0x243F6A8885A308D3ULL ^ (uint64_t)count;
+    int p = 0;
+    for (; p + 4 <= count; p += 4) {
+        uint64_t word = (uint64_t)board[p] | (uint64_t)board[p + 1] << 16 |
+                        (uint64_t)board[p + 2] << 32 | (uint64_t)board[p + 3] << 48;
+        h = (h ^ word) * 0x9E3779B97F4A7C15ULL;
+        h ^= h >> 32;
+    }
+    for (; p < count; p++) {
+        h = (h ^ board[p]) * 0x9E3779B97F4A7C15ULL;
+        h ^= h >> 32;
+    }
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// Open-addressing set of board hashes used to drop duplicate instances.
+// Two distinct boards sharing a 64-bit hash would be merged; at a few
+// million boards the chance of that is around 1e-6.
+typedef struct {
+    uint64_t *slots; // 0 marks an empty slot
+    size_t capacity; // Power of two
+    size_t size;
+} InstanceSet;
+
+static inline int instance_set_init(InstanceSet *set, size_t expected) {
+    set->capacity = 1024;
+    while (set->capacity < expected * 2)
+        set->capacity *= 2;
+    set->size = 0;
+    set->slots = calloc(set->capacity, sizeof(uint64_t));
+    return set->slots ? 0 : -1;
+}
+
+static inline void instance_set_free(InstanceSet *set) {
+    free(set->slots);
+    set->slots = NULL;
+    set->capacity = set->size = 0;
+}
+
+static inline int instance_set_place(uint64_t *slots, size_t capacity, uint64_t hash) {
+    size_t i = (size_t)hash & (capacity - 1);
+    while (slots[i] != 0) {
+        if (slots[i] == hash) return 0;
+        i = (i + 1) & (capacity - 1);
+    }
+    slots[i] = hash;
+    return 1;
+}
+
+// Returns 1 if the hash was new, 0 if already present, -1 on allocation failure
+static inline int instance_set_insert(InstanceSet *set, uint64_t hash) {
+    if (hash == 0) hash = 1;
+    if ((set->size + 1) * 2 > set->capacity) {
+        size_t capacity = set->capacity * 2;
+        uint64_t *slots = calloc(capacity, sizeof(uint64_t));
+        if (!slots) return -1;
+        for (size_t i = 0; i < set->capacity; i++) {
+            if (set->slots[i] != 0) instance_set_place(slots, capacity, set->slots[i]);
+        }
+        free(set->slots);
+        set->slots = slots;
+        set->capacity = capacity;
+    }
+    int added = instance_set_place(set->slots, set->capacity, hash);
+    set->size += (size_t)added;
+    return added;
+}
+
+#endif // INSTANCE_GEN_H
@@ -3,6 +3,9 @@
 #include <stdbool.h>
 #include <math.h>
 #include <time.h> 
+#include <stdint.h>
+#include "board_simd.h"
+#include "instance_gen.h"
 
 #define MAX_VARS 100
 #define MAX_CLAUSES 100
@@ -25,18 +28,13 @@ void add_clause(SATProblem *problem, int *clause) {
     problem->clauses[clause_index][i] = 0; // End with 0
 }
 
-// Helper function: Count inversions in the puzzle
+// Helper function: Count inversions in the puzzle (the blank tile is skipped)
 int count_inversions(int puzzle[], int size) {
-    int inversions = 0;
+    uint16_t tiles[size]; // The SIMD kernel works on 16-bit tiles
     for (int i = 0; i < size; i++) {
-        if (puzzle[i] == 0) continue; // Skip the blank tile
-        for (int j = i + 1; j < size; j++) {
-            if (puzzle[j] != 0 && puzzle[i] > puzzle[j]) {
-                inversions++;
-            }
-        }
+        tiles[i] = (uint16_t)puzzle[i];
     }
-    return inversions;
+    return (int)board_inversions(tiles, size);
 }
 
 // Helper function: Find the blank tile's row from the bottom
@@ -158,25 +156,22 @@ int main() {
 
     int max_dimension = 100;  // Maximum grid size (10x10)
     int trials = 10;        // Number of trials per dimension
+    uint64_t rng = instance_seed(1); // Fixed seed so timings are reproducible
 
     for (int dim = 3; dim <= max_dimension; dim++) {
         int size = dim * dim;
         int puzzle[size];
+        uint16_t tiles[size];
         double total_time = 0.0;
 
         printf("Testing %dx%d puzzles...\n", dim, dim);
 
         for (int trial = 0; trial < trials; trial++) {
-            // Generate a random puzzle
+            // Generate a random puzzle, solvable or not, so both answers are exercised
+            instance_goal(tiles, dim);
+            instance_shuffle(tiles, dim, &rng);
             for (int i = 0; i < size; i++) {
-                puzzle[i] = i;
-            }
-            // Shuffle the puzzle
-            for (int i = size - 1; i > 0; i--) {
-                int j = rand() % (i + 1);
-                int temp = puzzle[i];
-                puzzle[i] = puzzle[j];
-                puzzle[j] = temp;
+                puzzle[i] = tiles[i];
             }
 
             // Start timing